@@ -22,6 +22,16 @@ extern "C" {
 /**
  * Copy data in memory using DMAC
  *
+ * The calling thread waits until the transfer is done. To overlap a large
+ * copy (e.g. a framebuffer or a texture) with other work, issue it from a
+ * worker thread and signal its completion with an event flag.
+ *
+ * The DMAC does not see the data cache: write back the source range with
+ * `sceKernelDcacheWritebackRange` before the copy, and write back and
+ * invalidate the destination range with `sceKernelDcacheWritebackInvalidateRange`
+ * before it too, so that no dirty line is later written over the copied data
+ * and the CPU does not read stale lines afterwards.
+ *
  * @param dst A pointer to the destination
  * @param src A pointer to the source
  * @param size The size of data
@@ -33,7 +43,10 @@ extern "C" {
 int sceDmacMemcpy(void *dst, const void *src, SceSize size);
 
 /**
- * Tries tp copy data in memory using DMAC
+ * Tries to copy data in memory using DMAC
+ *
+ * Unlike ::sceDmacMemcpy, an error is returned instead of waiting when the
+ * DMAC is busy.
  *
  * @param dst A pointer to the destination
  * @param src A pointer to the source
@@ -79,6 +79,98 @@ typedef enum PspGeMatrixTypes {
 	PSP_GE_MATRIX_TEXGEN
 } PspGeMatrixTypes;
 
+/** GE commands, stored in the top 8 bits of each display list word. */
+typedef enum PspGeCommand {
+	/** No operation. */
+	PSP_GE_CMD_NOP = 0x00,
+	/** Vertex list address. */
+	PSP_GE_CMD_VADDR = 0x01,
+	/** Index list address. */
+	PSP_GE_CMD_IADDR = 0x02,
+	/** Draw primitives, the vertex count is in the lower 16 bits. */
+	PSP_GE_CMD_PRIM = 0x04,
+	/** Draw a bezier surface. */
+	PSP_GE_CMD_BEZIER = 0x05,
+	/** Draw a spline surface. */
+	PSP_GE_CMD_SPLINE = 0x06,
+	/** Bounding box test. */
+	PSP_GE_CMD_BBOX = 0x07,
+	/** Jump to an address. */
+	PSP_GE_CMD_JUMP = 0x08,
+	/** Jump to an address if the bounding box test failed. */
+	PSP_GE_CMD_BJUMP = 0x09,
+	/** Call a display list. */
+	PSP_GE_CMD_CALL = 0x0A,
+	/** Return from a display list call. */
+	PSP_GE_CMD_RET = 0x0B,
+	/** End of the display list. */
+	PSP_GE_CMD_END = 0x0C,
+	/** Raise a signal interrupt. */
+	PSP_GE_CMD_SIGNAL = 0x0E,
+	/** Raise a finish interrupt. */
+	PSP_GE_CMD_FINISH = 0x0F,
+	/** Upper bits of the addresses given to the following commands. */
+	PSP_GE_CMD_BASE = 0x10,
+	/** Vertex type. */
+	PSP_GE_CMD_VTYPE = 0x12,
+	/** Offset added to the following addresses. */
+	PSP_GE_CMD_OFFSETADDR = 0x13,
+	/** Set `PSP_GE_CMD_OFFSETADDR` to the address of this command. */
+	PSP_GE_CMD_ORIGIN = 0x14,
+	/** Bone matrix upload index. */
+	PSP_GE_CMD_BONE_MATRIX_NUMBER = 0x2A,
+	/** Bone matrix upload data, advances the index. */
+	PSP_GE_CMD_BONE_MATRIX_DATA = 0x2B,
+	/** World matrix upload index. */
+	PSP_GE_CMD_WORLD_MATRIX_NUMBER = 0x3A,
+	/** World matrix upload data, advances the index. */
+	PSP_GE_CMD_WORLD_MATRIX_DATA = 0x3B,
+	/** View matrix upload index. */
+	PSP_GE_CMD_VIEW_MATRIX_NUMBER = 0x3C,
+	/** View matrix upload data, advances the index. */
+	PSP_GE_CMD_VIEW_MATRIX_DATA = 0x3D,
+	/** Projection matrix upload index. */
+	PSP_GE_CMD_PROJ_MATRIX_NUMBER = 0x3E,
+	/** Projection matrix upload data, advances the index. */
+	PSP_GE_CMD_PROJ_MATRIX_DATA = 0x3F,
+	/** Texture generation matrix upload index. */
+	PSP_GE_CMD_TGEN_MATRIX_NUMBER = 0x40,
+	/** Texture generation matrix upload data, advances the index. */
+	PSP_GE_CMD_TGEN_MATRIX_DATA = 0x41,
+	/** Load the CLUT. */
+	PSP_GE_CMD_LOADCLUT = 0xC4,
+	/** Flush the texture cache. */
+	PSP_GE_CMD_TFLUSH = 0xCB,
+	/** Wait for texture transfers to complete. */
+	PSP_GE_CMD_TSYNC = 0xCC,
+	/** Start a block transfer. */
+	PSP_GE_CMD_TRXKICK = 0xEA
+} PspGeCommand;
+
+/** Statistics filled by `pspGeListGetStats()`. */
+typedef struct PspGeListStats {
+	/** Number of commands walked, including the final `PSP_GE_CMD_END` or `PSP_GE_CMD_RET`. */
+	u32 commands;
+	/** Number of commands for each ::PspGeCommand. */
+	u32 per_command[256];
+	/** Number of `PSP_GE_CMD_PRIM`, `PSP_GE_CMD_BEZIER` and `PSP_GE_CMD_SPLINE` commands. */
+	u32 prims;
+	/** Number of vertices drawn by `PSP_GE_CMD_PRIM` commands. */
+	u32 vertices;
+	/** Number of commands setting a register, i.e. not drawing nor changing the list flow. */
+	u32 state_changes;
+	/** Number of CLUT loads and block transfers. */
+	u32 texture_uploads;
+} PspGeListStats;
+
+/** Register values tracked by `pspGeListOptimize()`. */
+typedef struct PspGeRegState {
+	/** The value (lower 24 bits) of each command register. */
+	u32 value[256];
+	/** Bitmask of the registers whose value is known. */
+	u32 known[8];
+} PspGeRegState;
+
 /** List status for `sceGeListSync()` and `sceGeDrawSync()`. */
 typedef enum PspGeListState {
 	PSP_GE_LIST_DONE = 0,
@@ -115,10 +207,31 @@ int sceGeEdramSetSize(int size);
 /**
   * Get the eDRAM address.
   *
+  * Only the frame buffer and depth buffer pointers in display lists are
+  * relative to this base. Texture and CLUT addresses are absolute and may
+  * point to main RAM as well as to the eDRAM, so they must not be computed
+  * from this base.
+  *
   * @return A pointer to the base of the eDRAM.
+  *
+  * @attention Requires linking to `pspge_user`  or `pspge_driver` stubs to be available.
   */
 void * sceGeEdramGetAddr(void);
 
+/**
+  * Get the uncached eDRAM address.
+  *
+  * Accesses through this address bypass the data cache, so the CPU reads
+  * what the GE drew, and the GE sees what the CPU wrote, without writing back
+  * or invalidating the cache.
+  *
+  * @return A pointer to the base of the eDRAM, uncached.
+  */
+static __inline__ void *pspGeEdramGetUncachedAddr(void)
+{
+	return (void *)((uintptr_t)sceGeEdramGetAddr() | 0x40000000);
+}
+
 /**
  * Retrieve the current value of a GE command.
  *
@@ -308,6 +421,287 @@ int sceGeContinue(void);
  */
 int sceGeEdramSetAddrTranslation(int width);
 
+/**
+ * Resolve the target of a `PSP_GE_CMD_JUMP` command of a display list.
+ *
+ * The target is computed as the GE does, from the `PSP_GE_CMD_BASE` value
+ * and the current offset (see `PSP_GE_CMD_OFFSETADDR` and
+ * `PSP_GE_CMD_ORIGIN`), then mapped back to a pointer in the same memory
+ * segment as the list.
+ *
+ * @param[in] jump A pointer to the jump command.
+ * @param base The argument of the last `PSP_GE_CMD_BASE` command.
+ * @param offset The current offset, `0` at the head of an enqueued list.
+ *
+ * @return A pointer to the target, or `NULL` if it is not after the jump, as
+ * following it could loop forever.
+ */
+static __inline__ const u32 *pspGeListGetJumpTarget(const u32 *jump, u32 base, u32 offset)
+{
+	u32 addr, from;
+	const u32 *target;
+
+	addr = (((base & 0x000F0000) << 8) | (*jump & 0x00FFFFFC)) + offset;
+	from = (u32)((uintptr_t)jump & 0x0FFFFFFF);
+	target = (const u32 *)((const char *)jump + (int)(addr - from));
+
+	return (target > jump) ? target : NULL;
+}
+
+/**
+ * Gather statistics about a display list.
+ *
+ * The list is walked up to its first `PSP_GE_CMD_END` or `PSP_GE_CMD_RET`,
+ * so a called list can be passed too. Forward `PSP_GE_CMD_JUMP` commands,
+ * such as the ones `sceGuGetMemory()` emits over inline data, are followed,
+ * while called lists and conditional jumps are not. A `PSP_GE_CMD_END`
+ * right after a `PSP_GE_CMD_SIGNAL` belongs to the signal and does not end
+ * the walk.
+ *
+ * Comparing the statistics of the lists of a frame gives a cost model that
+ * does not need the hardware.
+ *
+ * @param[in] list The head of the list.
+ * @param[out] stats A pointer to a ::PspGeListStats to fill.
+ */
+static __inline__ void pspGeListGetStats(const u32 *list, PspGeListStats *stats)
+{
+	u32 i, cmd, prev = PSP_GE_CMD_NOP, base = 0, offset = 0;
+	int base_known = 0;
+
+	stats->commands = 0;
+	stats->prims = 0;
+	stats->vertices = 0;
+	stats->state_changes = 0;
+	stats->texture_uploads = 0;
+	for (i = 0; i < 256; i++)
+		stats->per_command[i] = 0;
+
+	for (;; prev = cmd, list++) {
+		cmd = *list >> 24;
+		stats->commands++;
+		stats->per_command[cmd]++;
+
+		switch (cmd) {
+		case PSP_GE_CMD_PRIM:
+			stats->vertices += *list & 0xFFFF;
+			/* fall through */
+		case PSP_GE_CMD_BEZIER:
+		case PSP_GE_CMD_SPLINE:
+			stats->prims++;
+			break;
+		case PSP_GE_CMD_LOADCLUT:
+		case PSP_GE_CMD_TRXKICK:
+			stats->texture_uploads++;
+			break;
+		case PSP_GE_CMD_TFLUSH:
+		case PSP_GE_CMD_TSYNC:
+			break;
+		case PSP_GE_CMD_END:
+			if (prev == PSP_GE_CMD_SIGNAL)
+				break;
+			return;
+		case PSP_GE_CMD_RET:
+			return;
+		case PSP_GE_CMD_JUMP:
+			if (!base_known)
+				return;
+			list = pspGeListGetJumpTarget(list, base, offset);
+			if (list == NULL)
+				return;
+			/* Step back, the loop moves to the next command. */
+			list--;
+			break;
+		case PSP_GE_CMD_BASE:
+			base = *list & 0xFFFFFF;
+			base_known = 1;
+			stats->state_changes++;
+			break;
+		case PSP_GE_CMD_OFFSETADDR:
+			offset = *list << 8;
+			stats->state_changes++;
+			break;
+		case PSP_GE_CMD_ORIGIN:
+			offset = (u32)((uintptr_t)list & 0x0FFFFFFF);
+			stats->state_changes++;
+			break;
+		default:
+			if (cmd > PSP_GE_CMD_FINISH)
+				stats->state_changes++;
+			break;
+		}
+	}
+}
+
+/**
+ * Forget all the register values of a ::PspGeRegState.
+ *
+ * @param[out] state A pointer to the state to clear.
+ */
+static __inline__ void pspGeRegStateClear(PspGeRegState *state)
+{
+	int i;
+
+	for (i = 0; i < 8; i++)
+		state->known[i] = 0;
+}
+
+/**
+ * Fill a ::PspGeRegState with the current GE registers.
+ *
+ * The GE must be idle, e.g. after `sceGeDrawSync(0)`.
+ *
+ * @param[out] state A pointer to the state to fill.
+ */
+static __inline__ void pspGeRegStateLoad(PspGeRegState *state)
+{
+	int i;
+
+	for (i = 0; i < 256; i++)
+		state->value[i] = sceGeGetCmd(i) & 0xFFFFFF;
+	for (i = 0; i < 8; i++)
+		state->known[i] = 0xFFFFFFFF;
+}
+
+/**
+ * Check whether a GE command only sets a register, so that setting it again
+ * to the same value has no effect.
+ *
+ * @param cmd The GE command.
+ *
+ * @return `1` if the command only sets a register, `0` otherwise.
+ */
+static __inline__ int pspGeCommandIsState(u32 cmd)
+{
+	switch (cmd) {
+	case PSP_GE_CMD_BASE:
+	case PSP_GE_CMD_VTYPE:
+		return 1;
+	case PSP_GE_CMD_OFFSETADDR:
+	case PSP_GE_CMD_ORIGIN:
+	case PSP_GE_CMD_BONE_MATRIX_NUMBER:
+	case PSP_GE_CMD_BONE_MATRIX_DATA:
+	case PSP_GE_CMD_LOADCLUT:
+	case PSP_GE_CMD_TFLUSH:
+	case PSP_GE_CMD_TSYNC:
+	case PSP_GE_CMD_TRXKICK:
+		return 0;
+	default:
+		if (cmd >= PSP_GE_CMD_WORLD_MATRIX_NUMBER && cmd <= PSP_GE_CMD_TGEN_MATRIX_DATA)
+			return 0;
+		/*
+		 * Commands up to 0x12 draw, change the list flow or are unused.
+		 * From there up to 0xEF, unused opcodes included, the remaining
+		 * commands only latch their argument.
+		 */
+		return cmd > 0x12 && cmd < 0xF0;
+	}
+}
+
+/**
+ * Remove redundant commands from a display list, in place.
+ *
+ * Commands setting a register to the value it already holds are replaced by
+ * `PSP_GE_CMD_NOP`, and `PSP_GE_CMD_PRIM` commands drawing the same kind of
+ * independent primitives (points, lines, triangles or sprites) back to back
+ * are merged. The list keeps its size, so addresses into it stay valid.
+ *
+ * Forward `PSP_GE_CMD_JUMP` commands, such as the ones `sceGuGetMemory()`
+ * emits over inline data, are followed using the tracked `PSP_GE_CMD_BASE`
+ * value and an offset that starts at `0`, as for a newly enqueued list.
+ * Processing stops at the first `PSP_GE_CMD_END`, or at the first call,
+ * return, conditional jump, signal or jump that cannot be followed, as the
+ * state after it is not known. In the latter case the state is cleared.
+ *
+ * The list can be optimized offline, starting from a cleared state, or just
+ * before `sceGeListEnQueue()` from a state filled with `pspGeRegStateLoad()`.
+ * In the latter case, write the list back from the data cache afterwards.
+ *
+ * @param[inout] list The head of the list.
+ * @param[inout] state The register values before the list. Updated to the
+ * values after the list if it reached `PSP_GE_CMD_END`, so it can be used for
+ * the list that follows, cleared otherwise.
+ *
+ * @return The number of commands removed.
+ */
+static __inline__ u32 pspGeListOptimize(u32 *list, PspGeRegState *state)
+{
+	/* Number of vertices per primitive, 0 for the kinds that cannot be merged. */
+	static const u32 prim_vertices[8] = { 1, 2, 0, 3, 0, 0, 2, 0 };
+	u32 *prim = NULL;
+	u32 cmd, arg, type, count, offset = 0, removed = 0;
+	const u32 *target;
+
+	for (;; list++) {
+		cmd = *list >> 24;
+		arg = *list & 0xFFFFFF;
+
+		if (cmd == PSP_GE_CMD_NOP)
+			continue;
+
+		if (cmd == PSP_GE_CMD_PRIM) {
+			type = (arg >> 16) & 7;
+			count = arg & 0xFFFF;
+			/* Only whole independent primitives can be merged. */
+			if (prim && ((*prim >> 16) & 7) == type && prim_vertices[type] != 0
+					&& (*prim & 0xFFFF) % prim_vertices[type] == 0
+					&& (*prim & 0xFFFF) + count <= 0xFFFF) {
+				*prim += count;
+				*list = PSP_GE_CMD_NOP << 24;
+				removed++;
+			} else {
+				prim = list;
+			}
+			continue;
+		}
+
+		if (pspGeCommandIsState(cmd)) {
+			if ((state->known[cmd >> 5] & (1u << (cmd & 31))) && state->value[cmd] == arg) {
+				*list = PSP_GE_CMD_NOP << 24;
+				removed++;
+				continue;
+			}
+			state->value[cmd] = arg;
+			state->known[cmd >> 5] |= 1u << (cmd & 31);
+			prim = NULL;
+			continue;
+		}
+
+		if (cmd == PSP_GE_CMD_END)
+			break;
+
+		if (cmd == PSP_GE_CMD_JUMP) {
+			/* A jump changes no register, carry on at its target. */
+			target = NULL;
+			if (state->known[PSP_GE_CMD_BASE >> 5] & (1u << (PSP_GE_CMD_BASE & 31)))
+				target = pspGeListGetJumpTarget(list, state->value[PSP_GE_CMD_BASE], offset);
+			if (target == NULL) {
+				pspGeRegStateClear(state);
+				break;
+			}
+			/* Step back, the loop moves to the next command. */
+			list = (u32 *)target - 1;
+			prim = NULL;
+			continue;
+		}
+
+		if ((cmd >= PSP_GE_CMD_BJUMP && cmd <= PSP_GE_CMD_RET) || cmd == PSP_GE_CMD_SIGNAL) {
+			/* The called or jumped to commands may change any register. */
+			pspGeRegStateClear(state);
+			break;
+		}
+
+		if (cmd == PSP_GE_CMD_OFFSETADDR)
+			offset = arg << 8;
+		else if (cmd == PSP_GE_CMD_ORIGIN)
+			offset = (u32)((uintptr_t)list & 0x0FFFFFFF);
+
+		/* Any other command may depend on the current state. */
+		prim = NULL;
+	}
+
+	return removed;
+}
 
 #ifdef __cplusplus
 }
@@ -17,6 +17,7 @@
 
 #include <psptypes.h>
 #include <pspkerneltypes.h>
+#include <psperror.h>
 #include <pspiofilemgr_stat.h>
 #include <pspiofilemgr_fcntl.h>
 #include <pspiofilemgr_dirent.h>
@@ -37,6 +38,44 @@ enum IoAssignPerms {
 	IOASSIGN_RDONLY = 1
 };
 
+/** Device types, as used in `PspIoDrv.dev_type` and returned by sceIoGetDevType */
+enum SceIoDevType {
+	/** Character device */
+	SCE_IO_DEV_TYPE_CHAR = 0x01,
+	/** Block device */
+	SCE_IO_DEV_TYPE_BLOCK = 0x04,
+	/** Filesystem device, can be mounted with sceIoAssign */
+	SCE_IO_DEV_TYPE_FS = 0x10,
+	/** Alias of another device */
+	SCE_IO_DEV_TYPE_ALIAS = 0x20,
+	/** Mount point created by sceIoAssign */
+	SCE_IO_DEV_TYPE_MOUNTPT = 0x40
+};
+
+/** A buffer segment for pspIoReadv and pspIoWritev */
+typedef struct PspIoVec {
+	/** Pointer to the start of the segment */
+	void *iov_base;
+	/** Size of the segment in bytes */
+	SceSize iov_len;
+} PspIoVec;
+
+/** Write buffer used by the pspIoWriteBuffer* helpers */
+typedef struct PspIoWriteBuffer {
+	/** The file descriptor the buffer is flushed to */
+	SceUID fd;
+	/** Pointer to the caller supplied buffer memory */
+	char *data;
+	/** Size of the buffer memory in bytes */
+	SceSize size;
+	/** Number of bytes currently buffered */
+	SceSize used;
+	/** Number of flushes, direct writes of large data included */
+	u32 flushes;
+	/** Number of bytes that went through the buffer */
+	u32 merged;
+} PspIoWriteBuffer;
+
 struct PspIoDrv;
 
 /** Structure passed to the init and exit functions of the io driver system */
@@ -61,36 +100,64 @@ typedef struct PspIoDrvFileArg {
 	void *arg;
 } PspIoDrvFileArg;
 
-/** Structure to maintain the file driver pointers */
+/**
+ * Structure to maintain the file driver pointers
+ *
+ * Each entry backs the sceIo call of the same name, both the synchronous and
+ * the asynchronous variants, which makes the table the single place to
+ * interpose on to trace or redirect every request made to a device.
+ */
 typedef struct PspIoDrvFuncs {
+	/** Called when the driver is added */
 	int (*IoInit)(PspIoDrvArg* arg);
+	/** Called when the driver is deleted */
 	int (*IoExit)(PspIoDrvArg* arg);
+	/** Backs sceIoOpen and sceIoOpenAsync */
 	int (*IoOpen)(PspIoDrvFileArg *arg, char *file, int flags, SceMode mode);
+	/** Backs sceIoClose and sceIoCloseAsync */
 	int (*IoClose)(PspIoDrvFileArg *arg);
+	/** Backs sceIoRead and sceIoReadAsync */
 	int (*IoRead)(PspIoDrvFileArg *arg, char *data, int len);
+	/** Backs sceIoWrite and sceIoWriteAsync */
 	int (*IoWrite)(PspIoDrvFileArg *arg, const char *data, int len);
+	/** Backs sceIoLseek, sceIoLseek32 and their asynchronous variants */
 	SceOff (*IoLseek)(PspIoDrvFileArg *arg, SceOff ofs, int whence);
+	/** Backs sceIoIoctl and sceIoIoctlAsync */
 	int (*IoIoctl)(PspIoDrvFileArg *arg, unsigned int cmd, void *indata, int inlen, void *outdata, int outlen);
+	/** Backs sceIoRemove */
 	int (*IoRemove)(PspIoDrvFileArg *arg, const char *name);
+	/** Backs sceIoMkdir */
 	int (*IoMkdir)(PspIoDrvFileArg *arg, const char *name, SceMode mode);
+	/** Backs sceIoRmdir */
 	int (*IoRmdir)(PspIoDrvFileArg *arg, const char *name);
+	/** Backs sceIoDopen */
 	int (*IoDopen)(PspIoDrvFileArg *arg, const char *dirname);
+	/** Backs sceIoDclose */
 	int (*IoDclose)(PspIoDrvFileArg *arg);
+	/** Backs sceIoDread */
 	int (*IoDread)(PspIoDrvFileArg *arg, SceIoDirent *dir);
+	/** Backs sceIoGetstat */
 	int (*IoGetstat)(PspIoDrvFileArg *arg, const char *file, SceIoStat *stat);
+	/** Backs sceIoChstat */
 	int (*IoChstat)(PspIoDrvFileArg *arg, const char *file, SceIoStat *stat, int bits);
+	/** Backs sceIoRename */
 	int (*IoRename)(PspIoDrvFileArg *arg, const char *oldname, const char *newname);
+	/** Backs sceIoChdir */
 	int (*IoChdir)(PspIoDrvFileArg *arg, const char *dir);
+	/** Called when the device is mounted with sceIoAssign */
 	int (*IoMount)(PspIoDrvFileArg *arg);
+	/** Called when the device is unmounted with sceIoUnassign */
 	int (*IoUmount)(PspIoDrvFileArg *arg);
+	/** Backs sceIoDevctl */
 	int (*IoDevctl)(PspIoDrvFileArg *arg, const char *devname, unsigned int cmd, void *indata, int inlen, void *outdata, int outlen);
+	/** Unknown */
 	int (*IoUnk21)(PspIoDrvFileArg *arg);
 } PspIoDrvFuncs;
 
 typedef struct PspIoDrv {
 	/** The name of the device to add */
 	const char *name;
-	/** Device type, this 0x10 is for a filesystem driver */
+	/** Device type, one of `SceIoDevType` (`SCE_IO_DEV_TYPE_FS` for a filesystem driver) */
 	u32 dev_type;
 	/** Unknown, set to 0x800 */
 	u32 unk2;
@@ -120,7 +187,8 @@ extern "C" {
  * }
  * @endcode
  *
- * @param file A pointer to a string holding the name of the file to open.
+ * @param file A pointer to a string holding the name of the file to open,
+ * relative paths are resolved against the thread current directory (see sceIoChdir).
  * @param flags A libc styled flags that are or'ed together.
  * @param mode The file access mode.
  *
@@ -337,7 +405,12 @@ int sceIoMkdir(const char *dir, SceMode mode);
 int sceIoRmdir(const char *path);
 
 /**
-  * Change the current directory.
+  * Change the current directory of the calling thread.
+  *
+  * Relative paths given to the other sceIo calls made by the thread are
+  * resolved against this directory. The directory is stored as a string and
+  * joined with every relative path, so absolute paths stay the cheapest to
+  * resolve.
   *
   * @param path The path to change to.
   *
@@ -428,6 +501,11 @@ int sceIoDevctl(const char *dev, unsigned int cmd, void *indata, int inlen, void
 /**
   * Assigns one IO device to another (I guess).
   *
+  * The filesystem driver `dev3` is mounted on top of the block device `dev2`
+  * and the result is reachable as `dev1`. Path resolution is done once by
+  * the filesystem driver, so a driver stacking several devices should keep
+  * its own lookup structure instead of probing each device on every open.
+  *
   * @param dev1 The device name to assign.
   * @param dev2 The block device to assign from.
   * @param dev3 The filesystem device to map the block device to `dev1`.
@@ -520,6 +598,9 @@ int sceIoIoctlAsync(SceUID fd, unsigned int cmd, void *indata, int inlen, void *
 /**
   * Synchronize the file data on the device.
   *
+  * Data written with sceIoWrite is only guaranteed to be on the device after
+  * this call or after the file is closed.
+  *
   * @param device The device to synchronize (e.g. "msfat0:").
   * @param unk Unknown.
   *
@@ -592,7 +673,7 @@ int sceIoCancel(SceUID fd);
   *
   * @param fd The opened file descriptor.
   *
-  * @return `< 0` on error. Otherwise the device type?
+  * @return `< 0` on error. Otherwise the device type, one of `SceIoDevType`.
   *
   * @attention Requires linking to `pspiofilemgr_user` or `pspiofilemgr_kernel` stubs to be available.
   */
@@ -601,6 +682,12 @@ int sceIoGetDevType(SceUID fd);
 /**
   * Change the priority of the asynchronous thread.
   *
+  * Asynchronous requests on a file descriptor are served by a thread owned by
+  * that descriptor, so giving latency sensitive descriptors (e.g. streamed
+  * audio) a higher priority than bulk loads lets their requests run first.
+  * The priority stays set for the lifetime of the descriptor, so set it once
+  * after sceIoOpen rather than before every request.
+  *
   * @param fd The opened fd on which the priority should be changed.
   * @param pri The priority of the thread.
   *
@@ -623,6 +710,374 @@ int sceIoChangeAsyncPriority(SceUID fd, int pri);
   */
 int sceIoSetAsyncCallback(SceUID fd, SceUID cb, void *argp);
 
+/**
+  * Read up to `count` entries from an opened directory file descriptor.
+  *
+  * Every entry is cleared before being handed to the driver, as some drivers
+  * (e.g. `ms0:`) use the `d_private` field and crash on garbage there.
+  *
+  * @param fd An already opened file descriptor (using sceIoDopen).
+  * @param dirs An array of at least `count` entries to hold the file information.
+  * @param count The maximum number of entries to read.
+  *
+  * @return The number of entries read, `0` if no entries were left, `< 0` on
+  * error if no entries could be read.
+  */
+static __inline__ int pspIoDreadMany(SceUID fd, SceIoDirent *dirs, int count)
+{
+	int n, ret;
+	SceSize i;
+
+	for (n = 0; n < count; n++) {
+		for (i = 0; i < sizeof(SceIoDirent); i++)
+			((char *)&dirs[n])[i] = 0;
+		ret = sceIoDread(fd, &dirs[n]);
+		if (ret < 0)
+			return (n > 0) ? n : ret;
+		if (ret == 0)
+			break;
+	}
+
+	return n;
+}
+
+/**
+  * Read a snapshot of a directory in one go.
+  *
+  * Opens the directory, reads up to `count` entries and closes it again. The
+  * snapshot is not updated by later `sceIoMkdir`, `sceIoRemove` or
+  * `sceIoRename` calls, it is up to the caller to take a new one.
+  *
+  * When `count` entries are read, one more entry is read to tell whether the
+  * directory holds more of them. Directories that may not fit in `dirs` should
+  * be read with pspIoDreadMany on an open descriptor instead.
+  *
+  * @par Example:
+  * @code
+  * SceIoDirent dirs[64];
+  * int truncated;
+  * int n = pspIoDirSnapshot("ms0:/PSP/SAVEDATA", dirs, 64, &truncated);
+  * @endcode
+  *
+  * @param dirname The directory to read.
+  * @param dirs An array of at least `count` entries to hold the file information.
+  * @param count The maximum number of entries to read.
+  * @param[out] truncated Set to `1` if the directory holds more than `count`
+  * entries, `0` otherwise. May be `NULL`.
+  *
+  * @return The number of entries read, `< 0` on error.
+  */
+static __inline__ int pspIoDirSnapshot(const char *dirname, SceIoDirent *dirs, int count, int *truncated)
+{
+	SceIoDirent extra;
+	SceUID fd;
+	unsigned int i;
+	int n, more = 0;
+
+	fd = sceIoDopen(dirname);
+	if (fd < 0)
+		return fd;
+
+	n = pspIoDreadMany(fd, dirs, count);
+	if (n >= 0 && n == count) {
+		for (i = 0; i < sizeof(SceIoDirent); i++)
+			((char *)&extra)[i] = 0;
+		more = sceIoDread(fd, &extra) > 0;
+	}
+	sceIoDclose(fd);
+
+	if (truncated)
+		*truncated = more;
+
+	return n;
+}
+
+/**
+  * Read input at the given offset.
+  *
+  * The firmware has no positional read, so this seeks and then reads. The
+  * file offset is left after the data read and is shared with every other
+  * user of `fd`: threads reading the same file in parallel should each open
+  * their own descriptor.
+  *
+  * @param fd A opened file descriptor to read from.
+  * @param data A pointer to the buffer where the read data will be placed.
+  * @param size The size of the read in bytes.
+  * @param offset The offset from the start of the file to read from.
+  *
+  * @return The number of bytes read, `< 0` on error.
+  */
+static __inline__ int pspIoPread(SceUID fd, void *data, SceSize size, SceOff offset)
+{
+	SceOff pos;
+
+	pos = sceIoLseek(fd, offset, PSP_SEEK_SET);
+	if (pos < 0)
+		return (int)pos;
+
+	return sceIoRead(fd, data, size);
+}
+
+/**
+  * Read input at the given offset (asynchronous).
+  *
+  * The seek is done synchronously, only the read itself is queued.
+  *
+  * @param fd A opened file descriptor to read from.
+  * @param data A pointer to the buffer where the read data will be placed.
+  * @param size The size of the read in bytes.
+  * @param offset The offset from the start of the file to read from.
+  *
+  * @return `< 0` on error.
+  */
+static __inline__ int pspIoPreadAsync(SceUID fd, void *data, SceSize size, SceOff offset)
+{
+	SceOff pos;
+
+	pos = sceIoLseek(fd, offset, PSP_SEEK_SET);
+	if (pos < 0)
+		return (int)pos;
+
+	return sceIoReadAsync(fd, data, size);
+}
+
+/**
+  * Write output at the given offset.
+  *
+  * See pspIoPread about the file offset.
+  *
+  * @param fd A opened file descriptor to write to.
+  * @param data A pointer to the data to write.
+  * @param size The size of data to write.
+  * @param offset The offset from the start of the file to write to.
+  *
+  * @return The number of bytes written, `< 0` on error.
+  */
+static __inline__ int pspIoPwrite(SceUID fd, const void *data, SceSize size, SceOff offset)
+{
+	SceOff pos;
+
+	pos = sceIoLseek(fd, offset, PSP_SEEK_SET);
+	if (pos < 0)
+		return (int)pos;
+
+	return sceIoWrite(fd, data, size);
+}
+
+/**
+  * Write output at the given offset (asynchronous).
+  *
+  * The seek is done synchronously, only the write itself is queued.
+  *
+  * @param fd A opened file descriptor to write to.
+  * @param data A pointer to the data to write.
+  * @param size The size of data to write.
+  * @param offset The offset from the start of the file to write to.
+  *
+  * @return `< 0` on error.
+  */
+static __inline__ int pspIoPwriteAsync(SceUID fd, const void *data, SceSize size, SceOff offset)
+{
+	SceOff pos;
+
+	pos = sceIoLseek(fd, offset, PSP_SEEK_SET);
+	if (pos < 0)
+		return (int)pos;
+
+	return sceIoWriteAsync(fd, data, size);
+}
+
+/**
+  * Read input into several buffers.
+  *
+  * The segments are filled in order, stopping at the first short read.
+  *
+  * @par Example: Read a header and a section into different buffers
+  * @code
+  * PspIoVec iov[2] = { { &header, sizeof(header) }, { section, section_size } };
+  * bytes_read = pspIoReadv(fd, iov, 2);
+  * @endcode
+  *
+  * @param fd A opened file descriptor to read from.
+  * @param iov An array of `count` segments to read into.
+  * @param count The number of segments.
+  *
+  * @return The total number of bytes read, `< 0` on error if nothing was read.
+  */
+static __inline__ int pspIoReadv(SceUID fd, const PspIoVec *iov, int count)
+{
+	int i, ret, total = 0;
+
+	for (i = 0; i < count; i++) {
+		ret = sceIoRead(fd, iov[i].iov_base, iov[i].iov_len);
+		if (ret < 0)
+			return (total > 0) ? total : ret;
+		total += ret;
+		if ((SceSize)ret < iov[i].iov_len)
+			break;
+	}
+
+	return total;
+}
+
+/**
+  * Write output from several buffers.
+  *
+  * The segments are written in order, stopping at the first short write.
+  *
+  * @param fd A opened file descriptor to write to.
+  * @param iov An array of `count` segments to write from.
+  * @param count The number of segments.
+  *
+  * @return The total number of bytes written, `< 0` on error if nothing was written.
+  */
+static __inline__ int pspIoWritev(SceUID fd, const PspIoVec *iov, int count)
+{
+	int i, ret, total = 0;
+
+	for (i = 0; i < count; i++) {
+		ret = sceIoWrite(fd, iov[i].iov_base, iov[i].iov_len);
+		if (ret < 0)
+			return (total > 0) ? total : ret;
+		total += ret;
+		if ((SceSize)ret < iov[i].iov_len)
+			break;
+	}
+
+	return total;
+}
+
+/**
+  * Initialise a write buffer.
+  *
+  * Small writes made through the buffer are merged into writes of up to
+  * `size` bytes. Buffered data is only handed to the file descriptor by
+  * pspIoWriteBufferFlush, so it must be flushed before sceIoSync or
+  * sceIoClose for these to make it durable.
+  *
+  * @par Example:
+  * @code
+  * static char buf[16 * 1024];
+  * PspIoWriteBuffer wb;
+  * pspIoWriteBufferInit(&wb, fd, buf, sizeof(buf));
+  * pspIoWriteBufferWrite(&wb, line, len);
+  * pspIoWriteBufferFlush(&wb);
+  * sceIoClose(fd);
+  * @endcode
+  *
+  * @param wb A pointer to the write buffer to initialise.
+  * @param fd A opened file descriptor to write to.
+  * @param data A pointer to the memory used for buffering.
+  * @param size The size of the buffering memory in bytes.
+  */
+static __inline__ void pspIoWriteBufferInit(PspIoWriteBuffer *wb, SceUID fd, void *data, SceSize size)
+{
+	wb->fd = fd;
+	wb->data = (char *)data;
+	wb->size = size;
+	wb->used = 0;
+	wb->flushes = 0;
+	wb->merged = 0;
+}
+
+/**
+  * Write output, retrying after short writes.
+  *
+  * @param fd A opened file descriptor to write to.
+  * @param data A pointer to the data to write.
+  * @param size The size of data to write.
+  * @param written A pointer to receive the number of bytes written, also on error.
+  *
+  * @return `0` if all the data was written, `< 0` on error. `SCE_ENOSPC` is
+  * returned if the device stopped accepting data.
+  */
+static __inline__ int pspIoWriteFull(SceUID fd, const void *data, SceSize size, SceSize *written)
+{
+	int ret;
+
+	*written = 0;
+	while (*written < size) {
+		ret = sceIoWrite(fd, (const char *)data + *written, size - *written);
+		if (ret < 0)
+			return ret;
+		if (ret == 0)
+			return (int)SCE_ENOSPC;
+		*written += ret;
+	}
+
+	return 0;
+}
+
+/**
+  * Write the buffered data to the file descriptor.
+  *
+  * @param wb A pointer to an initialised write buffer.
+  *
+  * @return `0` on success, `< 0` on error. The data that could not be written
+  * is kept at the start of the buffer on error.
+  */
+static __inline__ int pspIoWriteBufferFlush(PspIoWriteBuffer *wb)
+{
+	SceSize written, i;
+	int ret;
+
+	if (wb->used == 0)
+		return 0;
+
+	ret = pspIoWriteFull(wb->fd, wb->data, wb->used, &written);
+	if (written > 0)
+		wb->flushes++;
+	if (ret < 0) {
+		for (i = written; i < wb->used; i++)
+			wb->data[i - written] = wb->data[i];
+		wb->used -= written;
+		return ret;
+	}
+
+	wb->used = 0;
+
+	return 0;
+}
+
+/**
+  * Write output through a write buffer.
+  *
+  * Writes that do not fit in the buffer are written directly after flushing
+  * it.
+  *
+  * @param wb A pointer to an initialised write buffer.
+  * @param data A pointer to the data to write.
+  * @param size The size of data to write.
+  *
+  * @return The number of bytes written, `< 0` on error. On error while writing
+  * directly, part of the data may already have been written.
+  */
+static __inline__ int pspIoWriteBufferWrite(PspIoWriteBuffer *wb, const void *data, SceSize size)
+{
+	SceSize written, i;
+	int ret;
+
+	if (wb->used + size > wb->size) {
+		ret = pspIoWriteBufferFlush(wb);
+		if (ret < 0)
+			return ret;
+	}
+
+	if (size > wb->size) {
+		ret = pspIoWriteFull(wb->fd, data, size, &written);
+		if (written > 0)
+			wb->flushes++;
+		return (ret < 0) ? ret : (int)size;
+	}
+
+	for (i = 0; i < size; i++)
+		wb->data[wb->used + i] = ((const char *)data)[i];
+	wb->used += size;
+	wb->merged += size;
+
+	return size;
+}
+
 
 #ifdef __KERNEL__
 
@@ -633,13 +1088,36 @@ int sceIoSetAsyncCallback(SceUID fd, SceUID cb, void *argp);
   *
   * @return `< 0` on error.
   *
-  * @par Example:
+  * @par Example1: Replace the host driver
   * @code
   * PspIoDrvFuncs host_funcs = { ... };
-  * PspIoDrv host_driver = { "host", 0x10, 0x800, "HOST", &host_funcs };
+  * PspIoDrv host_driver = { "host", SCE_IO_DEV_TYPE_FS, 0x800, "HOST", &host_funcs };
   * sceIoDelDrv("host");
   * sceIoAddDrv(&host_driver);
   * @endcode
+  * @par Example2: A memory backed driver, reachable as `ram0:`
+  * @code
+  * static int ram_open(PspIoDrvFileArg *arg, char *file, int flags, SceMode mode)
+  * {
+  *	// Look up or create the file in the arena, keep it per descriptor.
+  *	arg->arg = ram_lookup(file, flags);
+  *	return arg->arg ? 0 : SCE_ENOENT;
+  * }
+  *
+  * static PspIoDrvFuncs ram_funcs = {
+  *	.IoInit = ram_init,
+  *	.IoExit = ram_exit,
+  *	.IoOpen = ram_open,
+  *	.IoClose = ram_close,
+  *	.IoRead = ram_read,
+  *	.IoWrite = ram_write,
+  *	.IoLseek = ram_lseek,
+  *	// Hand out the file's backing memory directly, without a copy.
+  *	.IoIoctl = ram_ioctl,
+  * };
+  * static PspIoDrv ram_driver = { "ram", SCE_IO_DEV_TYPE_FS, 0x800, "RAM", &ram_funcs };
+  * sceIoAddDrv(&ram_driver);
+  * @endcode
   *
   * @attention Requires linking to `pspiofilemgr_kernel` stub to be available.
   */
@@ -687,6 +1165,9 @@ int sceIoGetThreadCwd(SceUID uid, char *dir, int len);
 /**
  * Set the current working directory for a thread.
  *
+ * This is the kernel counterpart of sceIoChdir for threads other than the
+ * calling one.
+ *
  * @param uid The UID of the thread.
  * @param dir The directory to set.
  *
@@ -694,7 +1175,7 @@ int sceIoGetThreadCwd(SceUID uid, char *dir, int len);
  *
  * @attention Requires linking to `pspiofilemgr_kernel` stub to be available.
  */
-int sceIoChangeThreadCwd(SceUID uid, char *dir);
+int sceIoChangeThreadCwd(SceUID uid, const char *dir);
 
 #endif /* __KERNEL__ */
 
@@ -3,7 +3,7 @@
  * -----------------------------------------------------------------------
  * Licensed under the BSD license, see LICENSE in PSPSDK root for details.
  *
- * pspiofilemgr_devctl.h - File attributes and directory entries.
+ * pspiofilemgr_devctl.h - Device control commands and structures.
  *
  */
 
@@ -349,16 +349,6 @@ typedef struct SceLoadCoreExecFileInfo {
 	u32 max_seg_align; //188
 } SceLoadCoreExecFileInfo;
 
-/**
- * This structure represents a boot callback belonging to a module.
- */
-typedef struct SceBootCallback {
-	/** The boot callback function. */
-	void *boot_callback_func;
-	/** Global pointer value of the module. */
-	u32 gp;
-} SceBootCallback;
-
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -379,6 +369,13 @@ SceModule *sceKernelFindModuleByName(const char *modname);
 /**
  * Find a module from an address.
  *
+ * The loaded modules are searched on every call. When resolving many
+ * addresses, e.g. profiler samples, keep the `text_addr`/`text_size` range of
+ * the last module found and only call this when an address falls outside it.
+ * Both the cached range and the returned pointer become invalid once the
+ * module is unloaded. The same memory may then hold another module, so drop
+ * them whenever modules may have been unloaded and search again.
+ *
  * @param addr An address somewhere within the module.
  *
  * @returns A pointer to the `SceModule` structure if found, otherwise `NULL`.
@@ -63,6 +63,45 @@ static __inline__ int MScmUnregisterMSInsertEjectCallback(SceUID cbid)
 	return sceIoDevctl("fatms0:", 0x02415822, &cbid, sizeof(cbid), 0, 0);
 }
 
+/**
+ * Get the capacity information of the memory stick
+ *
+ * @param inf - Pointer to a SceDevInf structure to receive the information
+ *
+ * @return 0 on success, < 0 on error
+ */
+static __inline__ int MScmGetDevInfo(SceDevInf *inf)
+{
+	SceDevctlCmd cmd;
+
+	cmd.dev_inf = inf;
+	return sceIoDevctl("ms0:", SCE_PR_GETDEV, &cmd, sizeof(cmd), 0, 0);
+}
+
+/**
+ * Get the free space left on the memory stick
+ *
+ * The query goes all the way down to the FAT driver, so callers that need
+ * it often should keep the value and only refresh it after writing to the
+ * memory stick or when the insert/eject callback fires.
+ *
+ * @param size - Pointer to receive the free space, in bytes
+ *
+ * @return 0 on success, < 0 on error
+ */
+static __inline__ int MScmGetFreeSize(SceOff *size)
+{
+	SceDevInf inf;
+	int ret;
+
+	ret = MScmGetDevInfo(&inf);
+	if(ret < 0) return ret;
+
+	*size = (SceOff)inf.freeClusters * inf.sectorCount * inf.sectorSize;
+
+	return 0;
+}
+
 #endif /* __USER__ */
 
 #ifdef __cplusplus
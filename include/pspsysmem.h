@@ -28,10 +28,15 @@
 /** @addtogroup SysMem System Memory Manager */
 /*@{*/
 
+/** Structure filled by ::sceKernelQueryMemoryPartitionInfo */
 typedef struct _PspSysmemPartitionInfo {
+	/** Size of this structure, set it before querying */
 	SceSize size;
+	/** Lowest address of the partition */
 	unsigned int startaddr;
+	/** Size of the partition, in bytes */
 	unsigned int memsize;
+	/** Partition attributes */
 	unsigned int attr;
 } PspSysmemPartitionInfo;
 
@@ -60,7 +65,11 @@ enum PspSysMemBlockTypes {
 	/** Allocate from the highest available address. */
 	PSP_SMEM_High,
 	/** Allocate from the specified address. */
-	PSP_SMEM_Addr
+	PSP_SMEM_Addr,
+	/** Allocate from the lowest available address, aligned to the value passed as address. */
+	PSP_SMEM_LowAligned,
+	/** Allocate from the highest available address, aligned to the value passed as address. */
+	PSP_SMEM_HighAligned
 };
 
 typedef struct SceGameInfo {
@@ -89,6 +98,20 @@ typedef struct SceGameInfo {
 
 typedef int SceKernelSysMemAlloc_t;
 
+/** Structure filled by ::pspSysmemGetPartitionUsage */
+typedef struct PspSysmemPartitionUsage {
+	/** Lowest address of the partition */
+	unsigned int startaddr;
+	/** Size of the partition, in bytes */
+	SceSize memsize;
+	/** Total amount of free memory, in bytes */
+	SceSize freesize;
+	/** Size of the largest free memory block, in bytes */
+	SceSize maxfreesize;
+	/** Share of the free memory outside the largest free block, in percent */
+	unsigned int fragmentation;
+} PspSysmemPartitionUsage;
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -101,6 +124,7 @@ extern "C" {
  * @param type Specifies how the block is allocated within the partition.  One of ::PspSysMemBlockTypes.
  * @param size Size of the memory block, in bytes.
  * @param[in] addr If type is `PSP_SMEM_Addr`, then addr specifies the lowest address allocate the block from.
+ * If type is `PSP_SMEM_LowAligned` or `PSP_SMEM_HighAligned`, then addr specifies the alignment, a power of two.
  *
  * @returns The UID of the new block, `< 0` an error.
  *
@@ -288,9 +312,21 @@ SceSize sceKernelPartitionMaxFreeMemSize(int pid);
 /**
  * Set the protection of a block of ddr memory
  *
+ * The protection is enforced by the memory controller, so it costs nothing
+ * on accesses that are allowed. It only restricts user mode accesses, writes
+ * from kernel mode code (e.g. plugins) are never trapped. The memory
+ * controller tracks protection per 1 MiB block, so the whole blocks covering
+ * the range are affected.
+ *
+ * Removing write access from memory that user mode code should not change
+ * (e.g. around a block under suspicion of corruption) turns a stray write into
+ * a bus error, which can be caught with
+ * ::sceKernelRegisterDefaultExceptionHandler. The bus error is not precise,
+ * so the reported program counter may be past the faulting instruction.
+ *
  * @param[in] addr Address to set protection on.
  * @param size The size of block.
- * @param prot The protection bitmask.
+ * @param prot The protection bitmask, `0xF` grants full access.
  *
  * @return `< 0` on error
  *
@@ -315,6 +351,10 @@ SceUID sceKernelCreateHeap(SceUID partitionid, SceSize size, int unk, const char
 /**
  * Allocate a memory block from a heap.
  *
+ * Every allocation searches the heap for a fitting block. For many objects of
+ * the same size, a fixed pool (::sceKernelCreateFpl) per size class hands out
+ * and takes back blocks without searching.
+ *
  * @param heapid The UID of the heap to allocate from.
  * @param size The number of bytes to allocate.
  *
@@ -350,6 +390,9 @@ int sceKernelDeleteHeap(SceUID heapid);
 /**
  * Get the amount of free size of a heap, in bytes.
  *
+ * The free memory may be split among several blocks, so an allocation of
+ * that size is not guaranteed to succeed.
+ *
  * @param heapid The UID of the heap
  *
  * @returns the free size of the heap, in bytes. `< 0` on error.
@@ -452,6 +495,38 @@ void sceKernelSysMemDumpTail(void);
 
 #endif // defined(_PSP_FW_VERSION) && _PSP_FW_VERSION <= 340
 
+/**
+ * Get the usage of a partition in a machine-readable form.
+ *
+ * Unlike ::sceKernelSysMemDump, nothing is printed, so this can be sampled
+ * over a long session to track memory pressure.
+ *
+ * @param pid The partition ID.
+ * @param[out] usage A pointer to the `PspSysmemPartitionUsage` structure.
+ *
+ * @returns `0` on success, `< 0` on error.
+ */
+static __inline__ int pspSysmemGetPartitionUsage(int pid, PspSysmemPartitionUsage *usage)
+{
+	PspSysmemPartitionInfo info;
+	int ret;
+
+	info.size = sizeof(info);
+	ret = sceKernelQueryMemoryPartitionInfo(pid, &info);
+	if (ret < 0)
+		return ret;
+
+	usage->startaddr = info.startaddr;
+	usage->memsize = info.memsize;
+	usage->freesize = sceKernelPartitionTotalFreeMemSize(pid);
+	usage->maxfreesize = sceKernelPartitionMaxFreeMemSize(pid);
+	usage->fragmentation = 0;
+	if (usage->freesize > 0)
+		usage->fragmentation = 100 - (unsigned int)((u64)usage->maxfreesize * 100 / usage->freesize);
+
+	return 0;
+}
+
 #endif // __KERNEL__
 
 
@@ -1883,6 +1883,51 @@ int sceKernelCancelFpl(SceUID uid, int *pnum);
  */
 int sceKernelReferFplStatus(SceUID uid, SceKernelFplInfo *info);
 
+/**
+ * Get the number of bytes currently allocated from a VPL.
+ *
+ * Sampling this periodically gives the live size and allocation rate of a
+ * pool without instrumenting the code allocating from it.
+ *
+ * @param uid The uid of the VPL.
+ *
+ * @return The number of allocated bytes, `< 0` on error.
+ */
+static __inline__ int pspKernelVplUsedSize(SceUID uid)
+{
+	SceKernelVplInfo info;
+	int ret;
+
+	info.size = sizeof(info);
+	ret = sceKernelReferVplStatus(uid, &info);
+	if (ret < 0)
+		return ret;
+
+	return info.pool_size - info.free_size;
+}
+
+/**
+ * Get the number of bytes currently allocated from an FPL.
+ *
+ * See ::pspKernelVplUsedSize.
+ *
+ * @param uid The uid of the FPL.
+ *
+ * @return The number of allocated bytes, `< 0` on error.
+ */
+static __inline__ int pspKernelFplUsedSize(SceUID uid)
+{
+	SceKernelFplInfo info;
+	int ret;
+
+	info.size = sizeof(info);
+	ret = sceKernelReferFplStatus(uid, &info);
+	if (ret < 0)
+		return ret;
+
+	return (info.num_blocks - info.free_blocks) * info.block_size;
+}
+
 /**
  * Return from a timer handler (doesn't seem to do alot).
  *
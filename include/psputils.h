@@ -38,6 +38,11 @@ typedef struct SceKernelTimeval {
 	uint32_t tv_usec;
 } SceKernelTimeval;
 
+/** Size of a MD5 digest, in bytes */
+#define SCE_KERNEL_UTILS_MD5_DIGEST_SIZE	16
+/** Size of a SHA1 digest, in bytes */
+#define SCE_KERNEL_UTILS_SHA1_DIGEST_SIZE	20
+
 /** Structure for holding a mersenne twister context */
 typedef struct _SceKernelUtilsMt19937Context {
 	unsigned int 	count;
@@ -100,6 +105,13 @@ int sceKernelLibcGettimeofday(struct SceKernelTimeval *tp, struct timezone *tzp)
 /**
   * Write back the data cache to memory.
   *
+  * This walks the whole 16 KiB data cache once, while the range functions
+  * take one operation per 64 byte line of the range. Before handing a buffer
+  * smaller than the data cache to DMA (e.g. sceDmacMemcpy or a display list
+  * for sceGeListEnQueue), writing back only that buffer with
+  * sceKernelDcacheWritebackRange is cheaper. For buffers larger than the
+  * data cache, this function is the cheaper one.
+  *
   * @attention Requires linking to `psputils_user` or `psputils_kernel` stubs to be available.
   */
 void sceKernelDcacheWritebackAll(void);
@@ -107,6 +119,9 @@ void sceKernelDcacheWritebackAll(void);
 /**
   * Write back and invalidate the data cache.
   *
+  * See sceKernelDcacheWritebackAll about when flushing single buffers is
+  * cheaper.
+  *
   * @attention Requires linking to `psputils_user` or `psputils_kernel` stubs to be available.
   */
 void sceKernelDcacheWritebackInvalidateAll(void);
@@ -114,6 +129,11 @@ void sceKernelDcacheWritebackInvalidateAll(void);
 /**
   * Write back a range of addresses from the data cache to memory.
   *
+  * The range is extended to whole 64 byte cache lines.
+  *
+  * @param[in] p The start address of the range.
+  * @param size The size in bytes.
+  *
   * @attention Requires linking to `psputils_user` or `psputils_kernel` stubs to be available.
   */
 void sceKernelDcacheWritebackRange(const void *p, unsigned int size);
@@ -121,6 +141,9 @@ void sceKernelDcacheWritebackRange(const void *p, unsigned int size);
 /**
   * Write back and invalidate a range of addresses in the data cache.
   *
+  * @param[in] p The start address of the range.
+  * @param size The size in bytes.
+  *
   * @attention Requires linking to `psputils_user` or `psputils_kernel` stubs to be available.
   */
 void sceKernelDcacheWritebackInvalidateRange(const void *p, unsigned int size);
@@ -128,6 +151,12 @@ void sceKernelDcacheWritebackInvalidateRange(const void *p, unsigned int size);
 /**
   * Invalidate a range of addresses in data cache.
   *
+  * The range is extended to whole 64 byte cache lines, so data sharing the
+  * first or last line with the range is lost if it was not written back.
+  *
+  * @param[in] p The start address of the range.
+  * @param size The size in bytes.
+  *
   * @attention Requires linking to `psputils_user` or `psputils_kernel` stubs to be available.
   */
 void sceKernelDcacheInvalidateRange(const void *p, unsigned int size);
@@ -142,6 +171,9 @@ void sceKernelIcacheInvalidateAll(void);
 /**
   * Invalidate a range of addresses in the instruction cache.
   *
+  * @param[in] p The start address of the range.
+  * @param size The size in bytes.
+  *
   * @attention Requires linking to `psputils_user` or `psputils_kernel` stubs to be available.
   */
 void sceKernelIcacheInvalidateRange(const void *p, unsigned int size);
@@ -156,7 +188,7 @@ void sceKernelIcacheInvalidateRange(const void *p, unsigned int size);
   * @code
   * SceKernelUtilsMt19937Context ctx;
   * sceKernelUtilsMt19937Init(&ctx, time(NULL));
-  * u23 rand_val = sceKernelUtilsMt19937UInt(&ctx);
+  * u32 rand_val = sceKernelUtilsMt19937UInt(&ctx);
   * @endcode
   *
   * @return `< 0` on error.
@@ -170,12 +202,30 @@ int sceKernelUtilsMt19937Init(SceKernelUtilsMt19937Context *ctx, u32 seed);
   *
   * @param ctx A pointer to a pre-initialised context.
   *
-  * @return A pseudo random number (between `0` and `MAX_INT`).
+  * @return A pseudo random number (between `0` and `0xFFFFFFFF`).
   *
   * @attention Requires linking to `psputils_user` or `psputils_kernel` stubs to be available.
   */
 u32 sceKernelUtilsMt19937UInt(SceKernelUtilsMt19937Context *ctx);
 
+/**
+  * Function to fill a buffer with new psuedo random numbers.
+  *
+  * The values are the ones successive sceKernelUtilsMt19937UInt calls would
+  * return, in order.
+  *
+  * @param ctx A pointer to a pre-initialised context.
+  * @param buf A pointer to an array of at least `count` values to fill.
+  * @param count The number of values to generate.
+  */
+static __inline__ void pspKernelUtilsMt19937Fill(SceKernelUtilsMt19937Context *ctx, u32 *buf, u32 count)
+{
+	u32 i;
+
+	for (i = 0; i < count; i++)
+		buf[i] = sceKernelUtilsMt19937UInt(ctx);
+}
+
 /**
   * Function to perform an MD5 digest of a data block.
   *
@@ -292,6 +342,54 @@ int sceKernelUtilsSha1BlockUpdate(SceKernelUtilsSha1Context *ctx, u8 *data, u32
   */
 int sceKernelUtilsSha1BlockResult(SceKernelUtilsSha1Context *ctx, u8 *digest);
 
+/**
+  * Function to perform an MD5 digest of several independent data blocks.
+  *
+  * @param data An array of `count` pointers to the data blocks.
+  * @param size An array of `count` data block sizes.
+  * @param count The number of data blocks.
+  * @param digest A pointer to a `count * SCE_KERNEL_UTILS_MD5_DIGEST_SIZE` byte
+  * buffer to store the resulting digests, in order.
+  *
+  * @return `< 0` on error.
+  */
+static __inline__ int pspKernelUtilsMd5DigestMany(u8 **data, const u32 *size, int count, u8 *digest)
+{
+	int i, ret;
+
+	for (i = 0; i < count; i++) {
+		ret = sceKernelUtilsMd5Digest(data[i], size[i], digest + i * SCE_KERNEL_UTILS_MD5_DIGEST_SIZE);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+/**
+  * Function to SHA1 hash several independent data blocks.
+  *
+  * @param data An array of `count` pointers to the data blocks.
+  * @param size An array of `count` data block sizes.
+  * @param count The number of data blocks.
+  * @param digest A pointer to a `count * SCE_KERNEL_UTILS_SHA1_DIGEST_SIZE` byte
+  * buffer to store the resulting digests, in order.
+  *
+  * @return `< 0` on error.
+  */
+static __inline__ int pspKernelUtilsSha1DigestMany(u8 **data, const u32 *size, int count, u8 *digest)
+{
+	int i, ret;
+
+	for (i = 0; i < count; i++) {
+		ret = sceKernelUtilsSha1Digest(data[i], size[i], digest + i * SCE_KERNEL_UTILS_SHA1_DIGEST_SIZE);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
 /**@}*/
 
 #ifdef __KERNEL__
@@ -299,6 +397,11 @@ int sceKernelUtilsSha1BlockResult(SceKernelUtilsSha1Context *ctx, u8 *digest);
 /**
  * Decompress gzip'd data (requires kernel mode).
  *
+ * Only the gzip member at `src` is decompressed. A member stores neither its
+ * compressed size nor, until its trailer, its decompressed size, so the
+ * following members can only be located by decoding the previous ones or
+ * through an index of member offsets and sizes kept alongside the data.
+ *
  * @param[out] dest A pointer to destination buffer.
  * @param dest_size The size of destination buffer.
  * @param[in] src A pointer to source (compressed) data.
@@ -311,12 +414,15 @@ int sceKernelUtilsSha1BlockResult(SceKernelUtilsSha1Context *ctx, u8 *digest);
 int sceKernelGzipDecompress(u8 *dest, u32 dest_size, const u8 *src, void *unknown);
 
 /**
- * Decompress RLZ data (requires kernel mode)
+ * Decompress LZRC data (requires kernel mode).
  *
- * @param dest A pointer to destination buffer
- * @param dest_size The size of destination buffer
- * @param[in] src A pointer to source (compressed) data
- * @param[in] unknown Unknown, pass `NULL`
+ * There is no streaming mode, the whole stream is decoded in one call, so
+ * `dest` must be large enough to hold all of the decompressed data.
+ *
+ * @param[out] dest A pointer to destination buffer.
+ * @param dest_size The size of destination buffer.
+ * @param[in] src A pointer to source (compressed) data.
+ * @param[in] unknown Unknown, pass `NULL`.
  *
  * @return The decompressed size on success, `< 0` on error.
  *
@@ -325,11 +431,14 @@ int sceKernelGzipDecompress(u8 *dest, u32 dest_size, const u8 *src, void *unknow
 int sceKernelLzrcDecode(u8 *dest, u32 dest_size, const u8 *src, void *unknown);
 
 /**
- * Decompress inflate data (requires kernel mode)
+ * Decompress inflate data (requires kernel mode).
+ *
+ * `src` is a raw deflate stream, without the gzip or zlib headers, that is
+ * decoded in one call into `dest`.
  *
- * @param dest A pointer to destination buffer
- * @param dest_size The size of destination buffer
- * @param[in] src A pointer to source (compressed) data
+ * @param[out] dest A pointer to destination buffer.
+ * @param dest_size The size of destination buffer.
+ * @param[in] src A pointer to source (compressed) data.
  * @param[in] unknown Unknown, pass `NULL`.
  *
  * @return The decompressed size on success, `< 0` on error.